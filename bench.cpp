@@ -0,0 +1,297 @@
+// Microbenchmarks for the data structures in restaurant.cpp.
+//
+//   g++ -std=c++17 -O2 -pthread bench.cpp -o bench
+//   ./bench [--reps N] [--warmup N] [--filter NAME] [--label TEXT] [--out FILE]
+//
+// Every case runs its warm-up rounds, then N timed repetitions, and prints one
+// JSON object per line (time per operation in nanoseconds) so runs of two
+// versions can be diffed.
+#include "main.h"
+#include "restaurant.cpp"
+
+struct BenchOptions {
+	int reps = 30;
+	int warmup = 3;
+	string filter;
+	string label;
+};
+
+// swallows the output of printing operations
+class NullBuffer : public streambuf {
+protected:
+	int overflow(int c) override {
+		return traits_type::not_eof(c);
+	}
+};
+
+NullBuffer nullBuffer;
+ostream nullOut(&nullBuffer);
+
+// text as the body of a JSON string
+string jsonEscape(const string& text){
+	ostringstream out;
+	for (unsigned char c : text){
+		if (c == '"' || c == '\\'){
+			out << '\\' << c;
+		}
+		else if (c < 0x20){
+			out << "\\u" << hex << setw(4) << setfill('0') << (int)c << dec << setfill(' ');
+		}
+		else {
+			out << c;
+		}
+	}
+	return out.str();
+}
+
+template<class F>
+double timeIt(F f){
+	auto start = chrono::steady_clock::now();
+	f();
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// sample() runs one repetition of ops operations and returns the seconds spent
+// on the part being measured.
+template<class Sample>
+void runBench(const BenchOptions& options, ostream& out, string name, string params, long long ops, Sample sample){
+	if (!options.filter.empty() && name.find(options.filter) == string::npos){
+		return;
+	}
+	for (int i = 0; i < options.warmup; i++){
+		sample();
+	}
+	vector<double> ns;
+	for (int i = 0; i < options.reps; i++){
+		ns.push_back(sample() * 1e9 / ops);
+	}
+	sort(ns.begin(), ns.end());
+	double mean = accumulate(ns.begin(), ns.end(), 0.0) / ns.size();
+	double variance = 0;
+	for (double x : ns){
+		variance += (x - mean) * (x - mean);
+	}
+	double stddev = ns.size() > 1 ? sqrt(variance / (ns.size() - 1)) : 0;
+	double median = ns.size() % 2 ? ns[ns.size() / 2] : (ns[ns.size() / 2 - 1] + ns[ns.size() / 2]) / 2;
+
+	out << fixed << setprecision(2);
+	out << "{\"benchmark\":\"" << name << "\",\"params\":\"" << params << "\",\"label\":\"" << jsonEscape(options.label)
+		<< "\",\"reps\":" << ns.size() << ",\"ops\":" << ops
+		<< ",\"min_ns\":" << ns.front() << ",\"median_ns\":" << median << ",\"mean_ns\":" << mean
+		<< ",\"stddev_ns\":" << stddev << ",\"max_ns\":" << ns.back() << "}" << endl;
+}
+
+// weights for an alphabet: uniform, or geometric so a few letters dominate
+vector<pair<char, int>> huffmanLeaves(int alphabet, bool skewed){
+	vector<pair<char, int>> leaves;
+	for (int i = 0; i < alphabet; i++){
+		char c = i < 26 ? 'a' + i : 'A' + i - 26;
+		int weight = skewed ? max(1, (int)(4096 * pow(0.8, i))) : 16;
+		leaves.push_back({c, weight});
+	}
+	return leaves;
+}
+
+vector<int> bstValues(int n, bool sorted, mt19937& rng){
+	vector<int> values(n);
+	for (auto& v : values){
+		v = rng() % 1024;
+	}
+	if (sorted){
+		sort(values.begin(), values.end());
+	}
+	return values;
+}
+
+void benchHuffman(const BenchOptions& options, ostream& out){
+	const int builds = 1000;
+	for (int alphabet : {3, 8, 26, 52}){
+		for (bool skewed : {false, true}){
+			auto leaves = huffmanLeaves(alphabet, skewed);
+			string params = "alphabet=" + to_string(alphabet) + ",skew=" + (skewed ? "geometric" : "uniform");
+			runBench(options, out, "buildHuff", params, builds, [&]{
+				return timeIt([&]{
+					for (int i = 0; i < builds; i++){
+						delete buildHuff(leaves);
+					}
+				});
+			});
+		}
+	}
+}
+
+void benchBST(const BenchOptions& options, ostream& out){
+	mt19937 rng(1);
+	for (int n : {64, 1024, 4096}){
+		for (bool sorted : {false, true}){
+			auto values = bstValues(n, sorted, rng);
+			string params = "n=" + to_string(n) + ",input=" + (sorted ? "sorted" : "random");
+			runBench(options, out, "BinarySearchTree::add", params, n, [&]{
+				BinarySearchTree tree;
+				return timeIt([&]{
+					for (int v : values){
+						tree.add(v);
+					}
+				});
+			});
+			// KOKUSEN's eviction path: oldest first through deleteBinaryNode
+			runBench(options, out, "BinarySearchTree::deleteOldest", params, n, [&]{
+				BinarySearchTree tree;
+				for (int v : values){
+					tree.add(v);
+				}
+				return timeIt([&]{
+					while (tree.treeSize > 0){
+						tree.deleteOldest();
+					}
+				});
+			});
+		}
+	}
+}
+
+void benchNumOfWays(const BenchOptions& options, ostream& out){
+	mt19937 rng(2);
+	Gojo gojo;
+	for (int n : {8, 64, 256}){
+		for (bool sorted : {false, true}){
+			BinarySearchTree tree;
+			for (int v : bstValues(n, sorted, rng)){
+				tree.add(v);
+			}
+			vector<int> order;
+			tree.getArray(order);
+			string params = "n=" + to_string(n) + ",shape=" + (sorted ? "degenerate" : "random");
+			const int calls = n <= 64 ? 100 : 10;
+			runBench(options, out, "Gojo::numOfWays", params, calls, [&]{
+				return timeIt([&]{
+					for (int i = 0; i < calls; i++){
+						gojo.numOfWays(order);
+					}
+				});
+			});
+		}
+	}
+}
+
+void benchHeap(const BenchOptions& options, ostream& out){
+	mt19937 rng(3);
+	for (int maxsize : {64, 1024, 8192}){
+		MAXSIZE = maxsize;
+		int customers = maxsize * 4;
+		vector<int> IDs(customers);
+		for (auto& ID : IDs){
+			ID = rng() % maxsize + 1;
+		}
+		// customers are built up front so only the heap insert is timed
+		auto arrivals = [&]{
+			vector<customer*> cus;
+			for (int ID : IDs){
+				cus.push_back(new customer("bench", ID * 2));
+			}
+			return cus;
+		};
+		auto fill = [&](Sukuna& sukuna, const vector<customer*>& cus){
+			for (int i = 0; i < customers; i++){
+				sukuna.addCustomer(IDs[i], cus[i], IDs[i] * 2);
+			}
+		};
+		string params = "MAXSIZE=" + to_string(maxsize);
+		runBench(options, out, "RestaurantHeap::add", params, customers, [&]{
+			Sukuna sukuna;
+			vector<customer*> cus = arrivals();
+			return timeIt([&]{
+				fill(sukuna, cus);
+			});
+		});
+		const int queries = 100;
+		runBench(options, out, "RestaurantHeap::getIdArray", params + ",num=" + to_string(maxsize / 4), queries, [&]{
+			Sukuna sukuna;
+			fill(sukuna, arrivals());
+			return timeIt([&]{
+				for (int i = 0; i < queries; i++){
+					vector<int> IDs;
+					sukuna.Area.getIdArray(IDs, maxsize / 4);
+				}
+			});
+		});
+		runBench(options, out, "RestaurantHeap::keiteikenHelp", params + ",num=2", maxsize / 2, [&]{
+			Sukuna sukuna;
+			fill(sukuna, arrivals());
+			vector<int> victims;
+			sukuna.Area.getIdArray(victims, maxsize / 2);
+			return timeIt([&]{
+				for (int ID : victims){
+					sukuna.Area.keiteikenHelp(ID, 2, nullOut);
+				}
+			});
+		});
+	}
+}
+
+int usage(const char* program) {
+    cerr << "usage: " << program << " [--reps N] [--warmup N] [--filter NAME] [--label TEXT] [--out FILE]\n";
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    string outFile;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg != "--reps" && arg != "--warmup" && arg != "--filter" && arg != "--label" && arg != "--out") {
+            cerr << "unknown option: " << arg << "\n";
+            return usage(argv[0]);
+        }
+        if (i + 1 == argc) {
+            cerr << arg << " needs a value\n";
+            return usage(argv[0]);
+        }
+        string value = argv[++i];
+        if (arg == "--reps" || arg == "--warmup") {
+            size_t used = 0;
+            int n = 0;
+            try {
+                n = stoi(value, &used);
+            }
+            catch (const exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != value.size() || n < 0) {
+                cerr << arg << " needs a non-negative number, got " << value << "\n";
+                return usage(argv[0]);
+            }
+            if (arg == "--reps") {
+                options.reps = max(1, n);
+            }
+            else {
+                options.warmup = n;
+            }
+        }
+        else if (arg == "--filter") {
+            options.filter = value;
+        }
+        else if (arg == "--label") {
+            options.label = value;
+        }
+        else {
+            outFile = value;
+        }
+    }
+
+    ofstream file;
+    if (!outFile.empty()) {
+        file.open(outFile);
+        if (!file) {
+            cerr << "cannot open " << outFile << "\n";
+            return 1;
+        }
+    }
+    ostream& out = outFile.empty() ? cout : file;
+    benchHuffman(options, out);
+    benchBST(options, out);
+    benchNumOfWays(options, out);
+    benchHeap(options, out);
+
+    return 0;
+}
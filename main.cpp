@@ -1,8 +1,80 @@
 #include "main.h"
 #include "restaurant.cpp"
 
+int usage(const char* program) {
+    cerr << "usage: " << program << " [--diff | --lanes | --pipelined] [--bounded-memory] [--mem-report]\n"
+         << "       [--stream SOURCE [--flush latency|throughput]] [script]\n";
+    return 2;
+}
+
 int main(int argc, char* argv[]) {
     string fileName = "test.txt";
+    bool differential = false;
+    bool lanes = false;
+    bool pipelined = false;
+    string streamSource;
+    FlushPolicy flushPolicy = FLUSH_LATENCY;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--diff") {
+            differential = true;
+        }
+        else if (arg == "--lanes") {
+            lanes = true;
+        }
+        else if (arg == "--pipelined") {
+            pipelined = true;
+        }
+        else if (arg == "--bounded-memory") {
+            boundedMemory = true;
+        }
+        else if (arg == "--mem-report") {
+            memoryReport = true;
+        }
+        else if (arg == "--stream" || arg == "--flush") {
+            if (i + 1 == argc) {
+                cerr << arg << " needs a value\n";
+                return usage(argv[0]);
+            }
+            string value = argv[++i];
+            if (arg == "--stream") {
+                streamSource = value;
+            }
+            else if (value == "latency" || value == "throughput") {
+                flushPolicy = value == "throughput" ? FLUSH_THROUGHPUT : FLUSH_LATENCY;
+            }
+            else {
+                cerr << "unknown flush policy: " << value << "\n";
+                return usage(argv[0]);
+            }
+        }
+        else if (arg.compare(0, 2, "--") == 0) {
+            cerr << "unknown option: " << arg << "\n";
+            return usage(argv[0]);
+        }
+        else {
+            fileName = arg;
+        }
+    }
+
+    if (!streamSource.empty()) {
+        return simulateStream(streamSource, flushPolicy) ? 0 : 1;
+    }
+    if (!ifstream(fileName)) {
+        cerr << "cannot open " << fileName << "\n";
+        return 1;
+    }
+    if (differential) {
+        return simulateDifferential(fileName) ? 0 : 1;
+    }
+    if (lanes) {
+        simulateLanes(fileName);
+        return 0;
+    }
+    if (pipelined) {
+        simulatePipelined(fileName);
+        return 0;
+    }
     simulate(fileName);
 
     return 0;
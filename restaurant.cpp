@@ -3,8 +3,135 @@
 int MAXSIZE;
 class Restaurant;
 
+#include "reference.cpp"
+
+// Result keeps 10 bits, so no ID goes past min(MAXSIZE, MAX_ID).
+const int MAX_ID = 1024;
+
+// Size of an ID-indexed table that must hold ID and every ID to come.
+int idTableSize(int ID){
+	return max(ID, min(MAXSIZE, MAX_ID)) + 1;
+}
+
+// Live and peak bytes held by each subsystem. Objects count through their
+// class operator new/delete, containers through TrackedAllocator.
+enum Subsystem { HUFFMAN_MEM, GOJO_MEM, SUKUNA_MEM, CUSTOMER_MEM, SUBSYSTEMS };
+
+const char* const subsystemNames[] = { "huffman", "gojo", "sukuna", "customers" };
+
+// Counters are atomic because --lanes allocates and frees on several threads.
+struct MemoryStats {
+	atomic<long long> live[SUBSYSTEMS] = {};
+	atomic<long long> peak[SUBSYSTEMS] = {};
+
+	void allocate(int subsystem, size_t bytes){
+		long long now = live[subsystem].fetch_add(bytes, memory_order_relaxed) + bytes;
+		long long seen = peak[subsystem].load(memory_order_relaxed);
+		while (now > seen && !peak[subsystem].compare_exchange_weak(seen, now, memory_order_relaxed)){
+		}
+	}
+
+	void release(int subsystem, size_t bytes){
+		live[subsystem].fetch_sub(bytes, memory_order_relaxed);
+	}
+
+	void print(ostream& out){
+		long long totalLive = 0;
+		out << "subsystem   live(bytes)   peak(bytes)\n";
+		for (int i = 0; i < SUBSYSTEMS; i++){
+			totalLive += live[i].load();
+			out << left << setw(10) << subsystemNames[i] << right << setw(14) << live[i].load() << setw(14) << peak[i].load() << "\n";
+		}
+		out << left << setw(10) << "total" << right << setw(14) << totalLive << "\n";
+	}
+};
+
+MemoryStats memoryStats;
+
+// Bounded-memory mode: emptied Gojo areas are freed and the Sukuna heap
+// gives back spare capacity, so memory follows the live customers.
+bool boundedMemory = false;
+// print memoryStats to cerr when a simulation ends
+bool memoryReport = false;
+
+template<class T, int S>
+struct TrackedAllocator {
+	typedef T value_type;
+	template<class U> struct rebind { typedef TrackedAllocator<U, S> other; };
+
+	TrackedAllocator() = default;
+	template<class U> TrackedAllocator(const TrackedAllocator<U, S>&) {}
+
+	T* allocate(size_t n){
+		memoryStats.allocate(S, n * sizeof(T));
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T* p, size_t n){
+		memoryStats.release(S, n * sizeof(T));
+		std::allocator<T>().deallocate(p, n);
+	}
+	bool operator==(const TrackedAllocator&) const { return true; }
+	bool operator!=(const TrackedAllocator&) const { return false; }
+};
+
+template<class T, int S> using TrackedVector = vector<T, TrackedAllocator<T, S>>;
+template<class T, int S> using TrackedDeque = deque<T, TrackedAllocator<T, S>>;
+
+// Kept out of line: once inlined, GCC pairs the class operator delete that a
+// throwing constructor calls with ::operator new and warns about a mismatch.
+#define TRACKED_NEW(S) \
+	__attribute__((noinline)) static void* operator new(size_t size){ memoryStats.allocate(S, size); return ::operator new(size); } \
+	__attribute__((noinline)) static void operator delete(void* p, size_t size){ memoryStats.release(S, size); ::operator delete(p); }
+
+template<int S> using TrackedString = basic_string<char, char_traits<char>, TrackedAllocator<char, S>>;
+
+// Output of a print command, reused while the structure it was rendered
+// from is still at the same mutation version. The text is counted under S.
+template<int S>
+struct RenderCache {
+	long long version = -1;
+	TrackedString<S> text;
+
+	template<class Render>
+	const TrackedString<S>& get(long long current, Render render){
+		if (this->version != current){
+			if (boundedMemory){
+				// a local stream, so no render buffer outlives the call
+				ostringstream out;
+				store(out, render);
+				this->text.shrink_to_fit();
+			}
+			else {
+				thread_local ostringstream out;
+				out.str("");
+				store(out, render);
+			}
+			this->version = current;
+		}
+		return this->text;
+	}
+
+	// Called when the source structure changes. Bounded mode frees the old
+	// text right away instead of keeping it until the next render.
+	void stale(){
+		if (boundedMemory && this->version != -1){
+			this->version = -1;
+			TrackedString<S>().swap(this->text);
+		}
+	}
+
+private:
+	template<class Render>
+	void store(ostringstream& out, Render& render){
+		render(out);
+		string rendered = out.str();
+		this->text.assign(rendered.begin(), rendered.end());
+	}
+};
+
 class HuffmanNode{
 public:
+	TRACKED_NEW(HUFFMAN_MEM)
 	virtual ~HuffmanNode() = default; // Base destructor
 	virtual int getWeight() = 0; // Return frequency
 	virtual char getChar() = 0;
@@ -86,6 +213,7 @@ private:
 	HuffmanNode* root;
 	int priority;
 public:
+	TRACKED_NEW(HUFFMAN_MEM)
 	HuffmanTree(char& val, int freq, int priority){
 		this->root = new LeafNode(val, freq);
 		this->priority = priority;
@@ -99,6 +227,11 @@ public:
 		this->priority = priority;
 	}
 
+	HuffmanTree(HuffmanNode* root, int priority){
+		this->root = root;
+		this->priority = priority;
+	}
+
 	HuffmanNode* getRoot() { 
 		return root; 
 	}
@@ -119,30 +252,30 @@ public:
 		return this->priority;
 	}
 
-	int getHeight(HuffmanNode* node){
+	static int getHeight(HuffmanNode* node){
         if (node == NULL)
             return 0;
-        int lh = this->getHeight(node->getLeft());
-        int rh = this->getHeight(node->getRight());
+        int lh = getHeight(node->getLeft());
+        int rh = getHeight(node->getRight());
         return (lh > rh ? lh : rh) + 1;
     }
 
-	void printInOrderHuffTree(HuffmanNode* node){
+	void printInOrderHuffTree(HuffmanNode* node, ostream& out = cout){
 		if (node != nullptr){
-			printInOrderHuffTree(node->getLeft());
+			printInOrderHuffTree(node->getLeft(), out);
 			if (node->isLeaf()){
 				char c = node->getChar();
-				cout<<c<<"\n";
+				out<<c<<"\n";
 			}
 			else {
 				int w = node->getWeight();
-				cout<<w<<"\n";
+				out<<w<<"\n";
 			}
-			printInOrderHuffTree(node->getRight());
+			printInOrderHuffTree(node->getRight(), out);
 		}
 	}
 
-	HuffmanNode* rotateRight(HuffmanNode* node) {
+	static HuffmanNode* rotateRight(HuffmanNode* node) {
 		HuffmanNode *temp1 = node->getLeft();
 		HuffmanNode *temp2 = temp1->getRight();
 		node->setLeft(temp2);
@@ -150,7 +283,7 @@ public:
 		return temp1;
 	}
 
-	HuffmanNode* rotateLeft(HuffmanNode* node) {
+	static HuffmanNode* rotateLeft(HuffmanNode* node) {
 		HuffmanNode *temp1 = node->getRight();
 		HuffmanNode *temp2 = temp1->getLeft();
 		node->setRight(temp2);
@@ -158,13 +291,13 @@ public:
 		return temp1;
 	}
 
-	bool checkAvl(HuffmanNode *node){
+	static bool checkAvl(HuffmanNode *node){
 		if (node == nullptr) 	return true;
 		if (abs(getHeight(node->getLeft()) - getHeight(node->getRight())) > 1) return false;
 		return checkAvl(node->getLeft()) && checkAvl(node->getRight());
 	}
 
-	HuffmanNode* updateTree(HuffmanNode* node, int& rotationTime){	
+	static HuffmanNode* updateTree(HuffmanNode* node, int& rotationTime){	
 		while (abs(getHeight(node->getLeft()) - getHeight(node->getRight())) > 1 && rotationTime < 3){
 			int leftHigh = getHeight(node->getLeft());
 			int rightHigh = getHeight(node->getRight());
@@ -204,95 +337,293 @@ public:
 	}
 };
 
-struct CompareHuffmanTrees {
-    bool operator()(HuffmanTree* lhs, HuffmanTree* rhs) const {
-        if (lhs->getWeight() == rhs->getWeight()){
-			if ((lhs->getRoot()->isLeaf() == true) && (rhs->getRoot()->isLeaf() == true)){
-				if(islower(lhs->getChar()) && isupper(rhs->getChar())) {
-					return false;
-				} 
-				else if (isupper(lhs->getChar()) && islower(rhs->getChar())) {
-					return true;
-				} 
-				return lhs->getChar() > rhs->getChar();
-			}
-			return lhs->getPriority() > rhs->getPriority();
-		}
-        return lhs->getWeight() > rhs->getWeight();
-    }
+// buildHuff queue entry. key holds the weight in the high 32 bits and the
+// tie-break below it: leaves first (lowercase before uppercase, then by char),
+// then merged trees in creation order.
+// This matches the pop order of the old priority_queue only for names made
+// of letters, which is what the spec allows. For other bytes the old
+// comparator is not a strict weak order, so no key can reproduce it.
+struct HuffmanEntry {
+	unsigned long long key;
+	int node;
 };
 
-HuffmanTree* buildHuff(vector<HuffmanTree*>& huffNodes) {
-	priority_queue<HuffmanTree*, std::vector<HuffmanTree*>, CompareHuffmanTrees> keys(huffNodes.begin(), huffNodes.end());
+const int HUFFMAN_MAX_LEAVES = 256;
+
+unsigned long long huffmanLeafKey(char c, int weight){
+	return ((unsigned long long)weight << 32) | (isupper(c) ? 256 : 0) | (c + 128);
+}
+
+unsigned long long huffmanMergedKey(int weight, int priority){
+	return ((unsigned long long)weight << 32) | (512 + priority);
+}
+
+// Fixed-capacity binary min-heap on the stack, enough for every distinct char.
+class HuffmanQueue {
+private:
+	HuffmanEntry heap[HUFFMAN_MAX_LEAVES];
+	int count = 0;
+public:
+	int size(){
+		return this->count;
+	}
+
+	void push(HuffmanEntry entry){
+		int index = this->count++;
+		while (index > 0){
+			int parent = (index - 1) / 2;
+			if (heap[parent].key <= entry.key){
+				break;
+			}
+			heap[index] = heap[parent];
+			index = parent;
+		}
+		heap[index] = entry;
+	}
+
+	HuffmanEntry pop(){
+		HuffmanEntry top = heap[0];
+		HuffmanEntry last = heap[--this->count];
+		int index = 0;
+		while (true){
+			int child = index * 2 + 1;
+			if (child >= this->count){
+				break;
+			}
+			if (child + 1 < this->count && heap[child + 1].key < heap[child].key){
+				child++;
+			}
+			if (last.key <= heap[child].key){
+				break;
+			}
+			heap[index] = heap[child];
+			index = child;
+		}
+		heap[index] = last;
+		return top;
+	}
+};
+
+HuffmanTree* buildHuff(const vector<pair<char, int>>& leaves) {
+	if (leaves.empty()){
+		return nullptr;
+	}
+	HuffmanNode* nodes[2 * HUFFMAN_MAX_LEAVES];
+	HuffmanQueue keys;
+	int nodeCount = 0;
+	for (auto& leaf : leaves){
+		nodes[nodeCount] = new LeafNode(leaf.first, leaf.second);
+		keys.push({huffmanLeafKey(leaf.first, leaf.second), nodeCount});
+		nodeCount++;
+	}
 	int count = 1;
     while (keys.size() > 1) {
-		
-        HuffmanTree* temp1 = keys.top(); keys.pop();
-        HuffmanTree* temp2 = keys.top(); keys.pop();
-        HuffmanTree* temp3 = new HuffmanTree(temp1, temp2, count);
+		HuffmanNode* temp1 = nodes[keys.pop().node];
+		HuffmanNode* temp2 = nodes[keys.pop().node];
+		HuffmanNode* temp3 = new InternalNode(temp1, temp2);
 
 		int rotationTime = 0;
-		while(!temp3->checkAvl(temp3->getRoot()) && rotationTime < 3){
-			temp3->setRoot(temp3->updateTree(temp3->getRoot(), rotationTime));
+		while(!HuffmanTree::checkAvl(temp3) && rotationTime < 3){
+			temp3 = HuffmanTree::updateTree(temp3, rotationTime);
 		}
-		if (temp3->getRoot()->isLeaf() == true){
+		if (temp3->isLeaf() == true){
 			return nullptr;
 		}
-        keys.push(temp3);
+		nodes[nodeCount] = temp3;
+		keys.push({huffmanMergedKey(temp3->getWeight(), count), nodeCount});
+		nodeCount++;
 		count++;
     }
-    return keys.top();
+    return new HuffmanTree(nodes[keys.pop().node], count - 1);
 }
 
-void assignHuffmanCodes(HuffmanNode* root, string code, unordered_map<char, string>& codes) {
+void assignHuffmanCodes(HuffmanNode* root, string code, string* codes) {
     if (root) {
         if (root->isLeaf()) {
-            codes[root->getChar()] = code;
+            codes[(unsigned char)root->getChar()] = code;
         }
         assignHuffmanCodes(root->getLeft(), code + "0", codes);
         assignHuffmanCodes(root->getRight(), code + "1", codes);
     }
 }
 
-int binaryToDecimal(int binaryNum) {
-    int decimalNum = 0, temp = 0, remainder;
-    while (binaryNum != 0) {
-        remainder = binaryNum % 10;
-        binaryNum = binaryNum / 10; 
-        decimalNum = decimalNum + remainder * pow(2, temp);
-        temp++;
-    }
-    return decimalNum;
+// Byte kernels for LAPSE: character frequencies of the name and the per-letter
+// Caesar shift of the whole name.
+// Long names are counted into four tables so repeated letters do not stall on
+// the same counter.
+void countChars(const char* s, int n, int* freq){
+	if (n < 64){
+		for (int i = 0; i < n; i++){
+			freq[(unsigned char)s[i]]++;
+		}
+		return;
+	}
+	int part[3][256] = {};
+	int i = 0;
+	for (; i + 4 <= n; i += 4){
+		freq[(unsigned char)s[i]]++;
+		part[0][(unsigned char)s[i + 1]]++;
+		part[1][(unsigned char)s[i + 2]]++;
+		part[2][(unsigned char)s[i + 3]]++;
+	}
+	for (; i < n; i++){
+		freq[(unsigned char)s[i]]++;
+	}
+	for (int c = 0; c < 256; c++){
+		freq[c] += part[0][c] + part[1][c] + part[2][c];
+	}
+}
+
+void shiftNameScalar(char* s, int n, const char* shift){
+	for (int i = 0; i < n; i++){
+		s[i] = shift[(unsigned char)s[i]];
+	}
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LAPSE_SIMD 1
+#include <immintrin.h>
+
+// The SIMD versions only handle blocks made of letters and hand every other
+// block to the scalar loop, so all versions give identical results.
+// shift[] only matters for letters here: upper and lower case each index a
+// 26-entry table split into two 16-byte shuffles
+__attribute__((target("avx2")))
+void shiftNameAvx2(char* s, int n, const char* shift){
+	const __m256i upperTable0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(shift + 'A')));
+	const __m256i upperTable1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(shift + 'A' + 16)));
+	const __m256i lowerTable0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(shift + 'a')));
+	const __m256i lowerTable1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(shift + 'a' + 16)));
+	const __m256i upperLow = _mm256_set1_epi8('A' - 1), upperHigh = _mm256_set1_epi8('Z' + 1);
+	const __m256i lowerLow = _mm256_set1_epi8('a' - 1), lowerHigh = _mm256_set1_epi8('z' + 1);
+	const __m256i fifteen = _mm256_set1_epi8(15), sixteen = _mm256_set1_epi8(16);
+	int i = 0;
+	for (; i + 32 <= n; i += 32){
+		__m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+		__m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, upperLow), _mm256_cmpgt_epi8(upperHigh, v));
+		__m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, lowerLow), _mm256_cmpgt_epi8(lowerHigh, v));
+		if (_mm256_movemask_epi8(_mm256_or_si256(upper, lower)) != -1){
+			shiftNameScalar(s + i, 32, shift);
+			continue;
+		}
+		__m256i index = _mm256_sub_epi8(v, _mm256_blendv_epi8(_mm256_set1_epi8('a'), _mm256_set1_epi8('A'), upper));
+		__m256i high = _mm256_cmpgt_epi8(index, fifteen);
+		__m256i index1 = _mm256_sub_epi8(index, sixteen);
+		__m256i fromUpper = _mm256_blendv_epi8(_mm256_shuffle_epi8(upperTable0, index),
+			_mm256_shuffle_epi8(upperTable1, index1), high);
+		__m256i fromLower = _mm256_blendv_epi8(_mm256_shuffle_epi8(lowerTable0, index),
+			_mm256_shuffle_epi8(lowerTable1, index1), high);
+		_mm256_storeu_si256((__m256i*)(s + i), _mm256_blendv_epi8(fromLower, fromUpper, upper));
+	}
+	shiftNameScalar(s + i, n - i, shift);
+}
+
+__attribute__((target("sse4.2")))
+void shiftNameSse42(char* s, int n, const char* shift){
+	const __m128i upperTable0 = _mm_loadu_si128((const __m128i*)(shift + 'A'));
+	const __m128i upperTable1 = _mm_loadu_si128((const __m128i*)(shift + 'A' + 16));
+	const __m128i lowerTable0 = _mm_loadu_si128((const __m128i*)(shift + 'a'));
+	const __m128i lowerTable1 = _mm_loadu_si128((const __m128i*)(shift + 'a' + 16));
+	const __m128i upperLow = _mm_set1_epi8('A' - 1), upperHigh = _mm_set1_epi8('Z' + 1);
+	const __m128i lowerLow = _mm_set1_epi8('a' - 1), lowerHigh = _mm_set1_epi8('z' + 1);
+	const __m128i fifteen = _mm_set1_epi8(15), sixteen = _mm_set1_epi8(16);
+	int i = 0;
+	for (; i + 16 <= n; i += 16){
+		__m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, upperLow), _mm_cmplt_epi8(v, upperHigh));
+		__m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, lowerLow), _mm_cmplt_epi8(v, lowerHigh));
+		if (_mm_movemask_epi8(_mm_or_si128(upper, lower)) != 0xFFFF){
+			shiftNameScalar(s + i, 16, shift);
+			continue;
+		}
+		__m128i index = _mm_sub_epi8(v, _mm_blendv_epi8(_mm_set1_epi8('a'), _mm_set1_epi8('A'), upper));
+		__m128i high = _mm_cmpgt_epi8(index, fifteen);
+		__m128i index1 = _mm_sub_epi8(index, sixteen);
+		__m128i fromUpper = _mm_blendv_epi8(_mm_shuffle_epi8(upperTable0, index),
+			_mm_shuffle_epi8(upperTable1, index1), high);
+		__m128i fromLower = _mm_blendv_epi8(_mm_shuffle_epi8(lowerTable0, index),
+			_mm_shuffle_epi8(lowerTable1, index1), high);
+		_mm_storeu_si128((__m128i*)(s + i), _mm_blendv_epi8(fromLower, fromUpper, upper));
+	}
+	shiftNameScalar(s + i, n - i, shift);
+}
+#endif
+
+typedef void (*ShiftNameKernel)(char*, int, const char*);
+
+ShiftNameKernel selectShiftName(){
+#ifdef LAPSE_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")){
+		return shiftNameAvx2;
+	}
+	if (__builtin_cpu_supports("sse4.2")){
+		return shiftNameSse42;
+	}
+#endif
+	return shiftNameScalar;
 }
 
+const ShiftNameKernel shiftName = selectShiftName();
+
+// names shorter than this stay on the scalar loop
+const int LAPSE_SIMD_MIN_LENGTH = 64;
+
 class customer{
 	public:
 		string name;
 		int result;
 	public:
-		customer(){}
-		customer(string name, int res): name(name), result(res){}
-		~customer(){}
+		TRACKED_NEW(CUSTOMER_MEM)
+		// the name buffer is counted by capacity
+		customer(): result(0){
+			memoryStats.allocate(CUSTOMER_MEM, this->name.capacity());
+		}
+		customer(string name, int res): name(name), result(res){
+			memoryStats.allocate(CUSTOMER_MEM, this->name.capacity());
+		}
+		~customer(){
+			memoryStats.release(CUSTOMER_MEM, this->name.capacity());
+		}
 };
 
 class BinaryNode{
 public:
 	int data;// giá trị result từ LAPSE của khách
+	// set when an ancestor may hold the same data; never wrongly clear
+	bool equalAbove;
 	BinaryNode* left;
 	BinaryNode* right;
+	BinaryNode* parent;
+	// slot of the customer owning this node in customerInArea
+	BinaryNode** arrival;
 public:
-	BinaryNode(int data) : data(data), left(NULL), right(NULL) {}
+	TRACKED_NEW(GOJO_MEM)
+	BinaryNode(int data, BinaryNode* parent, bool equalAbove) : data(data), equalAbove(equalAbove), left(NULL), right(NULL), parent(parent), arrival(NULL) {}
 	~BinaryNode() {
 		this->left = nullptr;
 		this->right = nullptr;
 	}
 };
 
-class BinarySearchTree{
+class alignas(64) BinarySearchTree{
 public: 
 	BinaryNode* root;
-	queue<int> customerInArea;
+	// node of each customer in arrival order; deque keeps the slots in place
+	TrackedDeque<BinaryNode*, GOJO_MEM> customerInArea;
 	int treeSize;
+	// bumped on every add and delete; LIMITLESS output is cached against it
+	long long version = 0;
+	RenderCache<GOJO_MEM> inOrderCache;
+
+	static void* operator new(size_t size, align_val_t align){
+		memoryStats.allocate(GOJO_MEM, size);
+		return ::operator new(size, align);
+	}
+	static void operator delete(void* p, size_t size, align_val_t align){
+		memoryStats.release(GOJO_MEM, size);
+		::operator delete(p, align);
+	}
 
 	BinarySearchTree(){
 		this->root = nullptr;
@@ -310,123 +641,77 @@ public:
         }
     }
 	
-	void travelAdd(BinaryNode* node, int val){
-		if (val >= node->data){
-			if (node->right == nullptr){
-				node->right = new BinaryNode(val);
-				this->customerInArea.push(val);
-				this->treeSize++;
-			}
-			else {
-				travelAdd(node->right, val);
-			}
-		}
-		else {
-			if (node->left == nullptr){
-				node->left = new BinaryNode(val);
-				this->customerInArea.push(val);
-				this->treeSize++;
-			}
-			else {
-				travelAdd(node->left, val);
-			}
-		}
-	}
-
 	void add(int value){
-		if (this->root == nullptr){
-			this->root = new BinaryNode(value);
-			this->customerInArea.push(value);
-			this->treeSize++;
-			return;
+		BinaryNode* parent = nullptr;
+		BinaryNode** link = &this->root;
+		bool equalAbove = false;
+		while (*link != nullptr){
+			parent = *link;
+			equalAbove = equalAbove || parent->data == value;
+			link = value >= parent->data ? &parent->right : &parent->left;
 		}
-		travelAdd(this->root, value);
+		*link = new BinaryNode(value, parent, equalAbove);
+		this->customerInArea.push_back(*link);
+		(*link)->arrival = &this->customerInArea.back();
+		this->treeSize++;
+		this->version++;
+		this->inOrderCache.stale();
 	}
 
-	void travelDelete(BinaryNode* root, BinaryNode* preBinaryNode, int val){
-		if (root == nullptr){
-			return;
+	// Unlinks node the way a delete by value does: a node with two children
+	// takes its successor's data and the successor is removed instead.
+	void deleteBinaryNode(BinaryNode* node){
+		if (node->left != nullptr && node->right != nullptr){
+			BinaryNode* successor = node->right;
+			while (successor->left != nullptr){
+				successor = successor->left;
+			}
+			if (node->data != successor->data){
+				node->equalAbove = successor->equalAbove;
+			}
+			node->data = successor->data;
+			*successor->arrival = node;
+			node->arrival = successor->arrival;
+			node = successor;
 		}
-		if (val > root->data){
-			travelDelete(root->right, root, val);
+		BinaryNode* child = node->left != nullptr ? node->left : node->right;
+		if (child != nullptr){
+			child->parent = node->parent;
 		}
-		else if (val < root->data){
-			travelDelete(root->left, root, val);
+		if (node->parent == nullptr){
+			this->root = child;
+		}
+		else if (node->parent->left == node){
+			node->parent->left = child;
 		}
 		else {
-			if (root->left == nullptr && root->right == nullptr) {
-				if (preBinaryNode->left == root){
-					preBinaryNode->left = nullptr;
-				}
-				else {
-					preBinaryNode->right = nullptr;
-				}
-				delete root;
-				this->treeSize--;
-				return;
-			}
-			else if (root->left == nullptr){
-				if (preBinaryNode->left == root){
-					preBinaryNode->left = root->right;
-				}
-				else {
-					preBinaryNode->right = root->right;
-				}
-				delete root;
-				this->treeSize--;
-				return;
-			}
-			else if (root->right == nullptr){
-				if (preBinaryNode->left == root){
-					preBinaryNode->left = root->left;
-				}
-				else {
-					preBinaryNode->right = root->left;
-				}
-				delete root;
-				this->treeSize--;
-				return;
-			}
-			else {
-				BinaryNode* temp = root->right;
-				while (temp->left != nullptr){
-					temp = temp->left;
-				}
-				root->data = temp->data;
-				travelDelete(root->right, root, temp->data);
-			}
+			node->parent->right = child;
 		}
+		delete node;
+		this->treeSize--;
+		this->version++;
+		this->inOrderCache.stale();
 	}
 
-	void deleteBinaryNode(int value){
-		if (value > this->root->data){
-			travelDelete(root->right, root, value);
-		}
-		else if (value < this->root->data){
-			travelDelete(root->left, root, value);
-		}
-		else {
-			if (root->right == nullptr){
-				BinaryNode* temp = root;
-				this->root = root->left;
-				this->treeSize--;
-				delete temp;
-			}
-			else if (root->left == nullptr) {
-				BinaryNode* temp = root;
-				this->root = root->right;
-				this->treeSize--;
-				delete temp;
-			}
-			else {
-				BinaryNode* temp = root->right;
-				while (temp->left != nullptr){
-					temp = temp->left;
+	// Removes the oldest customer. A delete by value from the root would stop
+	// at the topmost node with that value, so that node goes; it holds the
+	// same value, so the two customers just trade nodes first.
+	void deleteOldest(){
+		BinaryNode* node = this->customerInArea.front();
+		BinaryNode* target = node;
+		if (node->equalAbove){
+			for (BinaryNode* p = node->parent; p != nullptr; p = p->parent){
+				if (p->data == node->data){
+					target = p;
 				}
-				root->data = temp->data;
-				travelDelete(root->right, root, temp->data);
 			}
 		}
+		if (target != node){
+			swap(*node->arrival, *target->arrival);
+			swap(node->arrival, target->arrival);
+		}
+		deleteBinaryNode(target);
+		this->customerInArea.pop_front();
 	}
 
 	void getArray(vector<int>& res){
@@ -446,11 +731,11 @@ public:
 		}
 	}
 
-	void printInOrder(BinaryNode* node){
+	void printInOrder(BinaryNode* node, ostream& out = cout){
 		if(node != nullptr){
-			printInOrder(node->left);
-			cout<<node->data<<"\n";
-			printInOrder(node->right);
+			printInOrder(node->left, out);
+			out<<node->data<<"\n";
+			printInOrder(node->right, out);
 		}
 	}
 
@@ -460,8 +745,7 @@ public:
 			return;
 		}
 		while (eraseTimes){
-			deleteBinaryNode(customerInArea.front());
-			customerInArea.pop();
+			deleteOldest();
 			eraseTimes--;
 		}
 	} 
@@ -469,20 +753,72 @@ public:
 
 class Gojo{
 public:
-	unordered_map<int, BinarySearchTree*> Area;
+	// Area[ID] is the BST for ID (slot 0 unused), allocated on first customer
+	TrackedVector<BinarySearchTree*, GOJO_MEM> Area;
+	// bit ID is set while Area[ID] holds at least one customer
+	TrackedVector<unsigned long long, GOJO_MEM> occupied;
 public:
-	void addCustomer(int ID, customer* cus, int result){
+	void growAreas(int ID){
+		int size = idTableSize(ID);
+		if (size <= (int)Area.size()){
+			return;
+		}
+		Area.resize(size, nullptr);
+		occupied.resize((size + 63) / 64, 0);
+	}
+
+	BinarySearchTree* getArea(int ID){
+		if (ID < 0 || ID >= (int)Area.size()){
+			return nullptr;
+		}
+		return Area[ID];
+	}
+
+	void updateOccupied(int ID){
+		if (Area[ID] != nullptr && Area[ID]->treeSize > 0){
+			occupied[ID >> 6] |= 1ULL << (ID & 63);
+		}
+		else {
+			occupied[ID >> 6] &= ~(1ULL << (ID & 63));
+			if (boundedMemory){
+				delete Area[ID];
+				Area[ID] = nullptr;
+			}
+		}
+	}
+
+	// smallest occupied ID greater than ID, or -1
+	int nextOccupied(int ID){
+		ID++;
+		int word = ID >> 6;
+		if (word >= (int)occupied.size()){
+			return -1;
+		}
+		unsigned long long bits = occupied[word] & (~0ULL << (ID & 63));
+		while (bits == 0){
+			word++;
+			if (word >= (int)occupied.size()){
+				return -1;
+			}
+			bits = occupied[word];
+		}
+		return (word << 6) + __builtin_ctzll(bits);
+	}
+
+	void addCustomer(int ID, int result){
+		growAreas(ID);
 		if (Area[ID] == nullptr) {
 			Area[ID] = new BinarySearchTree();
 		}
-        Area[ID]->add(cus->result);
+        Area[ID]->add(result);
+		updateOccupied(ID);
 	}
 
 	~Gojo() {
-        for (auto& pair : Area) {
-            delete pair.second;  
+        for (auto area : Area) {
+            delete area;
         }
-        Area.clear();  
+        Area.clear();
     }
 
 	int mod=1e9+7;
@@ -547,188 +883,195 @@ public:
 
 class RestaurantHeap {
 public:
+	// Customers of one ID. Nodes stay where they are allocated; the heap
+	// itself only moves HeapEntry handles.
     class HeapNode {
     public:
         int ID;
-        int Amount;
-		int	Priority;
-		queue<customer*> inHeap;
-        HeapNode(int ID, int Amount, int Priority, customer* cus){
+		TrackedDeque<customer*, SUKUNA_MEM> inHeap;
+		TRACKED_NEW(SUKUNA_MEM)
+        HeapNode(int ID, customer* cus){
             this->ID = ID;
-			this->Amount = Amount;
-			this->Priority = Priority;
-			this->inHeap.push(cus);
+			this->inHeap.push_back(cus);
         }
 		~HeapNode(){
-			while (!inHeap.empty()){
-				inHeap.pop();
+			for (auto cus : inHeap){
+				delete cus;
 			}
 		}
 
-		void printQueueLIFO(int num) {
-			stack<customer*> s;
-			queue<customer*> tempQueue = inHeap;
-
-			while (!tempQueue.empty()) {
-				s.push(tempQueue.front());
-				tempQueue.pop();
-			}
-			num = min(num, Amount);
-			while (num > 0) {
-				cout<<this->ID<<"-"<<s.top()->result<<"\n";
-				s.pop();
-				num--;
+		void printQueueLIFO(int num, ostream& out = cout) {
+			num = min(num, (int)inHeap.size());
+			for (auto it = inHeap.rbegin(); num > 0; ++it, num--) {
+				out<<this->ID<<"-"<<(*it)->result<<"\n";
 			}
 		}
 
-		void eraseCus(int num){
+		void eraseCus(int num, ostream& out = cout){
 			while (num > 0){
 				auto temp = inHeap.front();
-				cout<<temp->result<<"-"<<this->ID<<"\n";
-				inHeap.pop();
-				this->Amount--;
+				out<<temp->result<<"-"<<this->ID<<"\n";
+				inHeap.pop_front();
+				delete temp;
 				num--;
 			}
 		}
     };
+
+	// Heap handle ordered by key = Amount << PRIORITY_BITS | Priority, where
+	// Priority is the stamp of the node's last change. Stamps are unique, so
+	// one integer compare gives the Amount-then-Priority order.
+	struct HeapEntry {
+		unsigned long long key;
+		int ID;
+		int getAmount() const {
+			return key >> PRIORITY_BITS;
+		}
+		long long getPriority() const {
+			return key & PRIORITY_MASK;
+		}
+	};
+	static const int PRIORITY_BITS = 40;
+	static const unsigned long long PRIORITY_MASK = (1ULL << PRIORITY_BITS) - 1;
+
 public:
-    vector<HeapNode> heapRestaurant;
+    TrackedVector<HeapEntry, SUKUNA_MEM> heapRestaurant;
+	// nodes[ID] holds the customers of ID, nullptr when ID is not in the heap
+	TrackedVector<HeapNode*, SUKUNA_MEM> nodes;
+	// position[ID] is the index of ID in heapRestaurant, -1 when absent
+	TrackedVector<int, SUKUNA_MEM> position;
     long long count = 0;
+	// bumped on every change; CLEAVE output is cached per num against it
+	long long version = 0;
+	typedef unordered_map<int, RenderCache<SUKUNA_MEM>, hash<int>, equal_to<int>,
+		TrackedAllocator<pair<const int, RenderCache<SUKUNA_MEM>>, SUKUNA_MEM>> PreorderCache;
+	PreorderCache preorderCache;
 
 public:
+	~RestaurantHeap(){
+		for (auto node : nodes){
+			delete node;
+		}
+	}
 
 	int findIDIndex(int ID){
-		for (int i = 0; i < (int) heapRestaurant.size(); i++){
-			if (heapRestaurant[i].ID == ID){
-				return i;
-			}
+		if (ID < 0 || ID >= (int)position.size()){
+			return -1;
 		}
-		return -1;
+		return position[ID];
+	}
+
+	HeapNode* getNode(int index){
+		return nodes[heapRestaurant[index].ID];
+	}
+
+	void place(int index, HeapEntry entry){
+		heapRestaurant[index] = entry;
+		position[entry.ID] = index;
 	}
 
    void reheapUp(int index) {
+		HeapEntry entry = heapRestaurant[index];
 		while (index > 0) {
 			int parentIndex = (index - 1) / 2;
-			if (heapRestaurant[index].Amount < heapRestaurant[parentIndex].Amount ||
-				(heapRestaurant[index].Amount == heapRestaurant[parentIndex].Amount && 
-				heapRestaurant[index].Priority < heapRestaurant[parentIndex].Priority)) {
-				std::swap(heapRestaurant[index], heapRestaurant[parentIndex]);
-
-				index = parentIndex;
-			} 
-			else {
+			if (heapRestaurant[parentIndex].key <= entry.key) {
 				break;
 			}
+			place(index, heapRestaurant[parentIndex]);
+			index = parentIndex;
 		}
+		place(index, entry);
 	}
 
     void reheapDown(int index) {
 		int size = heapRestaurant.size();
-		int pos1, pos2, amount, amount1, amount2;
+		HeapEntry entry = heapRestaurant[index];
 
 		while (index * 2 + 1 < size) {
-			pos1 = index * 2 + 1;
-			pos2 = index * 2 + 2;
-
-			if (pos1 < size) {
-				amount = heapRestaurant[index].Amount;
-				int newIndex = index;
-				if (pos2 < size) {
-					amount1 = heapRestaurant[pos1].Amount;
-					amount2 = heapRestaurant[pos2].Amount;
-
-					if (amount1 < amount && amount1 < amount2) {
-						newIndex = pos1;
-					} 
-					else if (amount2 < amount && amount2 < amount1) {
-						newIndex = pos2;
-					}
-					else if(amount1 == amount2 && amount1 < amount){
-						newIndex = heapRestaurant[pos1].Priority < heapRestaurant[pos2].Priority ? pos1 : pos2;
-					}
-					else if (amount1 == amount2 && amount1 == amount){
-						newIndex = heapRestaurant[pos1].Priority < heapRestaurant[pos2].Priority ? pos1 : pos2;
-						newIndex = heapRestaurant[index].Priority < heapRestaurant[newIndex].Priority ? index : newIndex;
-					}
-					else if (amount1 == amount) {
-						newIndex = heapRestaurant[pos1].Priority < heapRestaurant[newIndex].Priority ? pos1 : newIndex;
-					}
-					else if (amount2 == amount) {
-						newIndex = heapRestaurant[pos2].Priority < heapRestaurant[newIndex].Priority ? pos2 : newIndex;
-					}
-				}
-
-				else {
-					amount1 = heapRestaurant[pos1].Amount;
-					if (amount1 < amount) {
-						newIndex = pos1;
-					} 
-					else if (amount1 == amount) {
-						if (heapRestaurant[pos1].Priority < heapRestaurant[index].Priority) {
-							newIndex = pos1;
-						}
-					}
-				}
-
-				if (newIndex != index) {
-					std::swap(heapRestaurant[index], heapRestaurant[newIndex]);
-					index = newIndex;
-				} 
-				else {
-					break;
-				}
-			} 
-			else {
+			int child = index * 2 + 1;
+			if (child + 1 < size && heapRestaurant[child + 1].key < heapRestaurant[child].key) {
+				child++;
+			}
+			if (entry.key <= heapRestaurant[child].key) {
 				break;
 			}
+			place(index, heapRestaurant[child]);
+			index = child;
 		}
+		place(index, entry);
 	}
 
 	void updatePriority(int pos){
 		count++;
-		this->heapRestaurant[pos].Priority = count;
+		this->heapRestaurant[pos].key = (this->heapRestaurant[pos].key & ~PRIORITY_MASK) | count;
 	}
 
 	void addHeap(int ID, int Amount, customer* cus){
 		count++;
-		HeapNode temp = HeapNode(ID, Amount, count, cus);
-		heapRestaurant.push_back(temp);
+		touch();
+		if (ID >= (int)position.size()){
+			position.resize(idTableSize(ID), -1);
+			nodes.resize(position.size(), nullptr);
+		}
+		nodes[ID] = new HeapNode(ID, cus);
+		heapRestaurant.push_back({((unsigned long long)Amount << PRIORITY_BITS) | count, ID});
+		position[ID] = (int)heapRestaurant.size() - 1;
         reheapUp((int)heapRestaurant.size() - 1);
 	}
 
+	void addCustomerAt(int pos, customer* cus){
+		touch();
+		heapRestaurant[pos].key += 1ULL << PRIORITY_BITS;
+		updatePriority(pos);
+		getNode(pos)->inHeap.push_back(cus);
+		reheapDown(pos);
+	}
+
 	void eraseHeapNode(int index){
-		if (index == (int) heapRestaurant.size() - 1){
-			heapRestaurant.pop_back();
+		touch();
+		int ID = heapRestaurant[index].ID;
+		delete nodes[ID];
+		nodes[ID] = nullptr;
+		position[ID] = -1;
+		HeapEntry last = heapRestaurant.back();
+		heapRestaurant.pop_back();
+		if (boundedMemory && heapRestaurant.size() < heapRestaurant.capacity() / 4){
+			heapRestaurant.shrink_to_fit();
+		}
+		if (index == (int) heapRestaurant.size()){
 			return;
 		}
 		else {
-			swap(heapRestaurant[index], heapRestaurant[(int)heapRestaurant.size() - 1]);
-			heapRestaurant.pop_back();
+			place(index, last);
 			reheapDown(index);
     		reheapUp(index);
 		}
 	}
 
+	// IDs of the num smallest (Amount, Priority) nodes, smallest first
 	void getIdArray(vector<int>& idKeiteiken, int num){
-		vector<HeapNode> temp(heapRestaurant.begin(), heapRestaurant.end());
-		sort(temp.begin(), temp.end(), [this](const auto& a, const auto& b) {
-            if (a.Amount == b.Amount){
-				return a.Priority < b.Priority;
-			}
-			return a.Amount < b.Amount;
-        });
-
 		num = min(num, (int)heapRestaurant.size());
+		if (num <= 0){
+			return;
+		}
+		vector<HeapEntry> keys(heapRestaurant.begin(), heapRestaurant.end());
+		partial_sort(keys.begin(), keys.begin() + num, keys.end(), [](const HeapEntry& a, const HeapEntry& b) {
+			return a.key < b.key;
+		});
+
 		for (int i = 0; i < num; i++){
-			idKeiteiken.push_back(temp[i].ID);
+			idKeiteiken.push_back(keys[i].ID);
 		}
 	}
 
-	void keiteikenHelp(int id, int num){
-		num = min(num, heapRestaurant[findIDIndex(id)].Amount);
+	void keiteikenHelp(int id, int num, ostream& out = cout){
+		touch();
 		int pos = findIDIndex(id);
-		heapRestaurant[pos].eraseCus(num);
-		if (heapRestaurant[pos].Amount == 0){
+		int amount = heapRestaurant[pos].getAmount();
+		num = min(num, amount);
+		getNode(pos)->eraseCus(num, out);
+		heapRestaurant[pos].key -= (unsigned long long)num << PRIORITY_BITS;
+		if (amount == num){
 			eraseHeapNode(pos);
 			return;
 		}
@@ -737,14 +1080,31 @@ public:
 		reheapDown(pos);
 	}
 
-	void printHeapPreorder(int index, int num) {
+	void printHeapPreorder(int index, int num, ostream& out = cout) {
 		if (index >= (int)heapRestaurant.size()) {
 			return;
 		}
-		heapRestaurant[index].printQueueLIFO(num);
-		printHeapPreorder(2 * index + 1, num);
-		printHeapPreorder(2 * index + 2, num);
-	}	
+		getNode(index)->printQueueLIFO(num, out);
+		printHeapPreorder(2 * index + 1, num, out);
+		printHeapPreorder(2 * index + 2, num, out);
+	}
+
+	// every mutation goes through here; bounded mode drops the stale renders
+	void touch(){
+		version++;
+		if (boundedMemory && !preorderCache.empty()){
+			PreorderCache().swap(preorderCache);
+		}
+	}
+
+	const TrackedString<SUKUNA_MEM>& renderPreorder(int num){
+		if (preorderCache.size() > 64){
+			preorderCache.clear();
+		}
+		return preorderCache[num].get(version, [this, num](ostream& out){
+			printHeapPreorder(0, num, out);
+		});
+	}
 };
 
 class Sukuna {
@@ -754,10 +1114,7 @@ public:
 	void addCustomer(int ID, customer* cus, int result){
 		int pos = Area.findIDIndex(ID);
 		if (pos != -1){
-			Area.heapRestaurant[pos].Amount++;
-			Area.updatePriority(pos); 
-			Area.heapRestaurant[pos].inHeap.push(cus);
-			Area.reheapDown(pos);
+			Area.addCustomerAt(pos, cus);
 		}
 		else {
 			Area.addHeap(ID, 1, cus);
@@ -770,6 +1127,9 @@ public:
 	Sukuna* sukuna;
 	Gojo* gojo;
 	HuffmanTree* lastCustomer;
+	// bumped whenever lastCustomer is replaced; HAND output is cached against it
+	long long handVersion = 0;
+	RenderCache<HUFFMAN_MEM> handCache;
 public:
 	Restaurant() {
 		this->sukuna = new Sukuna();
@@ -784,190 +1144,1008 @@ public:
     	}
 	}
 
-	void LAPSE(string name){
+	// Huffman part of LAPSE: replaces lastCustomer, encodes name and works out
+	// Result and the area ID. Returns false when the customer is turned away.
+	bool admit(string& name, int& ID, int& Result){
 		if (name.length() < 3){
-			return;
+			return false;
 		}
+		int length = name.length();
 		//Lay tan so
-		unordered_map<char, int> characters;
-		for (char c : name) {
-			characters[c]++;
+		int characters[256] = {};
+		countChars(name.data(), length, characters);
+		int distinct = 0;
+		for (int c = 0; c < 256; c++){
+			distinct += characters[c] > 0;
 		}
-		if(characters.size() < 3){
-			return;
+		if(distinct < 3){
+			return false;
 		}
 		//ma hoa Ceasar
-		vector<pair<char, int>> charVector(characters.begin(), characters.end());
-		
-		for (auto& c : charVector) {
-			if (isalpha(c.first)) {
-				char base = isupper(c.first) ? 'A' : 'a';
-				c.first = static_cast<char>((c.first - base + c.second) % 26 + base);
-			}
-		}
-		//Gop lai ket qua ma hoa
-		unordered_map<char, int> decode;
-		for (auto c : charVector) {
-			decode[c.first] += c.second;
-		}
-		//Sort 
-		charVector.clear();
-		charVector.assign(decode.begin(), decode.end());
-		sort(charVector.begin(), charVector.end(), [this](const auto& a, const auto& b) {
-            if (a.second == b.second){
-				if (islower(a.first) && isupper(b.first)) {
-					return true;
-				} else if (isupper(a.first) && islower(b.first)) {
-					return false;
-				} 
-				else {
-					return a.first < b.first;
-				}
+		char shift[256] = {};
+		int decode[256] = {};
+		for (int c = 0; c < 256; c++) {
+			if (characters[c] == 0){
+				continue;
 			}
-			return a.second < b.second;
-        });
-		
-		//Tạo huffTree
-		vector<HuffmanTree*> huffNodes; 
-		for (auto c : charVector){
-			HuffmanTree* temp = new HuffmanTree(c.first, c.second, 0);
-			huffNodes.push_back(temp);
+			char ch = static_cast<char>(c);
+			char base = isupper(ch) ? 'A' : 'a';
+			shift[c] = static_cast<char>((ch - base + characters[c]) % 26 + base);
+			//Gop lai ket qua ma hoa
+			decode[(unsigned char)(isalpha(ch) ? shift[c] : ch)] += characters[c];
 		}
-		
-		HuffmanTree* root = buildHuff(huffNodes);
+		vector<pair<char, int>> charVector;
+		for (int c = 0; c < 256; c++){
+			if (decode[c] > 0){
+				charVector.push_back({static_cast<char>(c), decode[c]});
+			}
+		}
+
+		//Tạo huffTree
+		HuffmanTree* root = buildHuff(charVector);
 		if (root == nullptr){
-			return;
+			return false;
 		}
+		delete this->lastCustomer;
 		this->lastCustomer = root;
+		this->handVersion++;
+		this->handCache.stale();
 		//Lay ma thap phan
 
 		if (root->getRoot()->getLeft() == nullptr && root->getRoot()->getRight() == nullptr){
-			customer* cus = new customer(name, 0);
-			this->sukuna->addCustomer(1, cus, 0);
-			return;
+			ID = 1;
+			Result = 0;
+			return true;
 		}
 
-		unordered_map<char, string> codes;
+		string codes[256];
 		assignHuffmanCodes(root->getRoot(), "", codes);
 
-		string binaryString = "";
-		for (int i = 0; i < (int)name.length(); i++){
-			auto it = characters.find(name[i]);
-			char base = isupper(it->first) ? 'A' : 'a';
-			name[i] = static_cast<char>((it->first - base + it->second) % 26 + base);
-			auto temp = codes.find(name[i]);
-			if (temp != codes.end()) {
-				binaryString += temp->second;
-			}
+		if (length >= LAPSE_SIMD_MIN_LENGTH){
+			shiftName(&name[0], length, shift);
+		}
+		else {
+			shiftNameScalar(&name[0], length, shift);
 		}
 
-		string temp = "";
-		for (int i = binaryString.length() - 1; i >= 0; i--){
-			if (temp.length() == 10){
-				break;
+		// Result reads the last 10 bits of the encoded name from right to left
+		int bits = 0;
+		Result = 0;
+		for (int i = length - 1; i >= 0 && bits < 10; i--){
+			const string& code = codes[(unsigned char)name[i]];
+			for (int j = (int)code.length() - 1; j >= 0 && bits < 10; j--){
+				Result = Result * 2 + (code[j] - '0');
+				bits++;
 			}
-			temp += binaryString[i];
 		}
 
-		int Result = binaryToDecimal(stoi(temp));
-		int ID = Result % MAXSIZE + 1;
-		customer* cus = new customer(name, Result);
+		ID = Result % MAXSIZE + 1;
+		return true;
+	}
+
+	void seat(const string& name, int ID, int Result){
 		if (Result & 1){
-			this->gojo->addCustomer(ID, cus, Result);
+			this->gojo->addCustomer(ID, Result);
 		}
 		else {
+			customer* cus = new customer(name, Result);
 			this->sukuna->addCustomer(ID, cus, Result);
 		}
 	}
 
+	void LAPSE(string name){
+		int ID, Result;
+		if (admit(name, ID, Result)){
+			seat(name, ID, Result);
+		}
+	}
+
 	void KOKUSEN(){
 		long long permutations = 1;
-		for (auto area : this->gojo->Area){
+		for (int ID = this->gojo->nextOccupied(0); ID != -1; ID = this->gojo->nextOccupied(ID)){
+			BinarySearchTree* area = this->gojo->Area[ID];
 			vector<int> temp;
-			if (area.second == nullptr){
-				continue;
-			}
-			else if (area.second->treeSize <= 1){
+			if (area->treeSize <= 1){
 				permutations = 1;
 			}
 			else {
-				area.second->getArray(temp);
+				area->getArray(temp);
 				permutations = this->gojo->numOfWays(temp) % MAXSIZE;
 			}
-			area.second->kokusenHelp(permutations);
+			area->kokusenHelp(permutations);
+			this->gojo->updateOccupied(ID);
 		}
 	}
 
-	void KEITEIKEN(int num){
+	void KEITEIKEN(int num, ostream& out = cout){
 		vector<int> idKeiteiken;
 		this->sukuna->Area.getIdArray(idKeiteiken, num);
 		int size = idKeiteiken.size();
 
 		for (int i = 0; i < size; i++){
-			this->sukuna->Area.keiteikenHelp(idKeiteiken[i], num);
+			this->sukuna->Area.keiteikenHelp(idKeiteiken[i], num, out);
 		}
 	}
 
-	void HAND(){
+	void HAND(ostream& out = cout){
 		if (this->lastCustomer == nullptr){
 			return;
 		}
-		this->lastCustomer->printInOrderHuffTree(this->lastCustomer->getRoot());
+		out << this->handCache.get(this->handVersion, [this](ostream& text){
+			this->lastCustomer->printInOrderHuffTree(this->lastCustomer->getRoot(), text);
+		});
 	}
 
-	void LIMITLESS(int num){
-		if (this->gojo->Area[num] == nullptr){
+	void LIMITLESS(int num, ostream& out = cout){
+		BinarySearchTree* area = this->gojo->getArea(num);
+		if (area == nullptr){
 			return;
 		}
-		this->gojo->Area[num]->printInOrder(this->gojo->Area[num]->root);
+		out << area->inOrderCache.get(area->version, [area](ostream& text){
+			area->printInOrder(area->root, text);
+		});
 	}
 
-	void CLEAVE(int num){
-		this->sukuna->Area.printHeapPreorder(0, num);
+	void CLEAVE(int num, ostream& out = cout){
+		out << this->sukuna->Area.renderPreorder(num);
 	}
 		
 };
 
+enum Opcode { MAXSIZE_CMD, LAPSE_CMD, KOKUSEN_CMD, KEITEIKEN_CMD, HAND_CMD, LIMITLESS_CMD, CLEAVE_CMD };
+
+const char* const opcodeNames[] = { "MAXSIZE", "LAPSE", "KOKUSEN", "KEITEIKEN", "HAND", "LIMITLESS", "CLEAVE" };
+
+// One script command. An argument missing at the end of the input keeps the
+// value from the previous command, as the original reading loop did.
+struct Command {
+	Opcode op;
+	int num = 0;
+	string name;
+};
+
+bool readCommand(istream& ss, Command& cmd){
+	string str, num;
+	if (!(ss >> str)){
+		return false;
+	}
+	if (str == "MAXSIZE") cmd.op = MAXSIZE_CMD;
+	else if (str == "LAPSE") cmd.op = LAPSE_CMD;
+	else if (str == "KOKUSEN") cmd.op = KOKUSEN_CMD;
+	else if (str == "KEITEIKEN") cmd.op = KEITEIKEN_CMD;
+	else if (str == "HAND") cmd.op = HAND_CMD;
+	else if (str == "LIMITLESS") cmd.op = LIMITLESS_CMD;
+	else cmd.op = CLEAVE_CMD;
+
+	if (cmd.op == LAPSE_CMD){
+		ss >> cmd.name;
+	}
+	else if (cmd.op != KOKUSEN_CMD && cmd.op != HAND_CMD){
+		if (ss >> num){
+			cmd.num = stoi(num);
+		}
+	}
+	return true;
+}
+
+template<class R>
+void runCommand(R* r, const Command& cmd){
+	switch (cmd.op){
+		case MAXSIZE_CMD: MAXSIZE = cmd.num; break;
+		case LAPSE_CMD: r->LAPSE(cmd.name); break;
+		case KOKUSEN_CMD: r->KOKUSEN(); break;
+		case KEITEIKEN_CMD: r->KEITEIKEN(cmd.num); break;
+		case HAND_CMD: r->HAND(); break;
+		case LIMITLESS_CMD: r->LIMITLESS(cmd.num); break;
+		case CLEAVE_CMD: r->CLEAVE(cmd.num); break;
+	}
+}
+
 void simulate(string filename)
 {
 	Restaurant* r = new Restaurant();
 	ifstream ss(filename);
-	string str, maxsize, name, num;
-	while(ss >> str)
-	{ 
-		if(str == "MAXSIZE")
-		{
-			ss >> maxsize;
-			MAXSIZE = stoi(maxsize);
-    	}
-        else if(str == "LAPSE") 
-        {
-            ss >> name;
-			r->LAPSE(name);
-    	}
-    	else if(str == "KOKUSEN") 
-    	{
-             r->KOKUSEN();  
+	Command cmd;
+	while (readCommand(ss, cmd))
+	{
+		runCommand(r, cmd);
+	}
+	if (memoryReport){
+		memoryStats.print(cerr);
+	}
+	delete r;
+	return;
+}
+
+// FNV-1a over the observable state, used by --diff to catch divergences that
+// have not reached the output yet.
+struct StateDigest {
+	unsigned long long hash = 1469598103934665603ULL;
+	void add(long long value){
+		for (int i = 0; i < 8; i++){
+			hash ^= (value >> (8 * i)) & 0xFF;
+			hash *= 1099511628211ULL;
+		}
+	}
+};
+
+template<class Node>
+void digestHuffman(StateDigest& d, Node* node){
+	if (node == nullptr){
+		d.add(0);
+		return;
+	}
+	d.add(node->isLeaf() ? 1 : 2);
+	d.add(node->getWeight());
+	if (node->isLeaf()){
+		d.add(node->getChar());
+	}
+	digestHuffman(d, node->getLeft());
+	digestHuffman(d, node->getRight());
+}
+
+template<class Node>
+void digestBST(StateDigest& d, Node* node){
+	if (node == nullptr){
+		d.add(-1);
+		return;
+	}
+	d.add(node->data);
+	digestBST(d, node->left);
+	digestBST(d, node->right);
+}
+
+void digestArrivals(StateDigest& d, queue<int> arrivals){
+	while (!arrivals.empty()){
+		d.add(arrivals.front());
+		arrivals.pop();
+	}
+}
+
+template<class Arrivals>
+void digestArrivals(StateDigest& d, const Arrivals& arrivals){
+	for (auto node : arrivals){
+		d.add(node->data);
+	}
+}
+
+template<class Tree>
+void digestArea(StateDigest& d, int ID, Tree* area){
+	d.add(ID);
+	d.add(area->treeSize);
+	digestBST(d, area->root);
+	digestArrivals(d, area->customerInArea);
+}
+
+template<class Heap>
+void digestHeap(StateDigest& d, Heap& heap){
+	d.add(heap.count);
+	for (auto& node : heap.heapRestaurant){
+		d.add(node.ID);
+		d.add(node.Amount);
+		d.add(node.Priority);
+		auto customers = node.inHeap;
+		while (!customers.empty()){
+			d.add(customers.front()->result);
+			customers.pop();
 		}
-    	else if(str == "KEITEIKEN") 
-    	{
-    		ss >> num;
-			r->KEITEIKEN(stoi(num));
+	}
+}
+
+void digestHeap(StateDigest& d, RestaurantHeap& heap){
+	d.add(heap.count);
+	for (auto& entry : heap.heapRestaurant){
+		d.add(entry.ID);
+		d.add(entry.getAmount());
+		d.add(entry.getPriority());
+		for (auto cus : heap.nodes[entry.ID]->inHeap){
+			d.add(cus->result);
 		}
-		else if(str == "HAND") 
-		{
-    		r->HAND();		
+	}
+}
+
+unsigned long long digestState(reference::Restaurant* r){
+	StateDigest d;
+	digestHuffman(d, r->lastCustomer == nullptr ? nullptr : r->lastCustomer->getRoot());
+	vector<int> IDs;
+	for (auto& area : r->gojo->Area){
+		if (area.second != nullptr && area.second->treeSize > 0){
+			IDs.push_back(area.first);
 		}
-    	else if(str == "LIMITLESS")
-     	{   	
-    		ss >> num;
-			r->LIMITLESS(stoi(num));	
-    	}
-    	else
-    	{
-    		ss >> num;
-			r->CLEAVE(stoi(num));	
-    	}
-    }
-	return;
-}
\ No newline at end of file
+	}
+	sort(IDs.begin(), IDs.end());
+	for (int ID : IDs){
+		digestArea(d, ID, r->gojo->Area[ID]);
+	}
+	digestHeap(d, r->sukuna->Area);
+	return d.hash;
+}
+
+unsigned long long digestState(Restaurant* r){
+	StateDigest d;
+	digestHuffman(d, r->lastCustomer == nullptr ? nullptr : r->lastCustomer->getRoot());
+	for (int ID = r->gojo->nextOccupied(0); ID != -1; ID = r->gojo->nextOccupied(ID)){
+		digestArea(d, ID, r->gojo->Area[ID]);
+	}
+	digestHeap(d, r->sukuna->Area);
+	return d.hash;
+}
+
+// Runs filename through reference::Restaurant and Restaurant in lockstep.
+// The optimized output goes to cout; after every command both outputs and
+// state digests are compared, and the first divergence is reported on cerr
+// together with per-command timings. Returns false on divergence.
+bool simulateDifferential(string filename)
+{
+	reference::Restaurant* expected = new reference::Restaurant();
+	Restaurant* actual = new Restaurant();
+	ifstream ss(filename);
+	Command cmd;
+	double expectedTime[7] = {}, actualTime[7] = {};
+	long long executed[7] = {};
+	long long line = 0;
+	bool same = true;
+	streambuf* console = cout.rdbuf();
+	while (readCommand(ss, cmd))
+	{
+		line++;
+		ostringstream expectedOut, actualOut;
+
+		cout.rdbuf(expectedOut.rdbuf());
+		auto start = chrono::steady_clock::now();
+		runCommand(expected, cmd);
+		auto middle = chrono::steady_clock::now();
+		cout.rdbuf(actualOut.rdbuf());
+		runCommand(actual, cmd);
+		auto end = chrono::steady_clock::now();
+		cout.rdbuf(console);
+
+		expectedTime[cmd.op] += chrono::duration<double>(middle - start).count();
+		actualTime[cmd.op] += chrono::duration<double>(end - middle).count();
+		executed[cmd.op]++;
+		cout << actualOut.str();
+
+		string divergence;
+		if (expectedOut.str() != actualOut.str()){
+			divergence = "output";
+		}
+		else if (digestState(expected) != digestState(actual)){
+			divergence = "state";
+		}
+		if (!divergence.empty()){
+			cerr << "divergence in " << divergence << " at command " << line << ": " << opcodeNames[cmd.op];
+			if (cmd.op == LAPSE_CMD) cerr << " " << cmd.name;
+			else if (cmd.op != KOKUSEN_CMD && cmd.op != HAND_CMD) cerr << " " << cmd.num;
+			cerr << "\n";
+			if (divergence == "output"){
+				cerr << "--- reference output\n" << expectedOut.str() << "--- optimized output\n" << actualOut.str();
+			}
+			same = false;
+			break;
+		}
+	}
+
+	double expectedTotal = 0, actualTotal = 0;
+	cerr << fixed << setprecision(6);
+	cerr << "command     count  reference(s)  optimized(s)  speedup\n";
+	for (int op = 0; op < 7; op++){
+		if (executed[op] == 0){
+			continue;
+		}
+		expectedTotal += expectedTime[op];
+		actualTotal += actualTime[op];
+		cerr << left << setw(10) << opcodeNames[op] << right << setw(7) << executed[op]
+			<< setw(14) << expectedTime[op] << setw(14) << actualTime[op]
+			<< setw(9) << setprecision(2) << expectedTime[op] / max(actualTime[op], 1e-9) << "x\n" << setprecision(6);
+	}
+	cerr << left << setw(10) << "total" << right << setw(7) << line
+		<< setw(14) << expectedTotal << setw(14) << actualTotal
+		<< setw(9) << setprecision(2) << expectedTotal / max(actualTotal, 1e-9) << "x\n";
+	cerr << (same ? "no divergence\n" : "diverged\n");
+
+	delete expected;
+	delete actual;
+	return same;
+}
+
+// Waits in a SPSC queue spin briefly, then yield so a lane never starves the
+// thread it is waiting for on a busy machine.
+void backoff(int& spins){
+	if (++spins > 64){
+		this_thread::yield();
+	}
+}
+
+// Bounded lock-free single-producer/single-consumer ring. push waits while
+// the ring is full, which keeps a fast producer from buffering without end.
+template<class T>
+class SpscQueue {
+private:
+	vector<T> slots;
+	size_t mask;
+	alignas(64) atomic<size_t> head{0};
+	alignas(64) atomic<size_t> tail{0};
+	alignas(64) atomic<bool> closed{false};
+public:
+	// capacity is rounded up to a power of two
+	explicit SpscQueue(size_t capacity){
+		size_t size = 1;
+		while (size < capacity){
+			size <<= 1;
+		}
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	void push(T value){
+		*claim() = std::move(value);
+		publish();
+	}
+
+	// In-place push: fill the slot returned by claim, then publish it. Slots
+	// are reused, so buffers they own keep their capacity.
+	T* claim(){
+		size_t t = tail.load(memory_order_relaxed);
+		int spins = 0;
+		while (t - head.load(memory_order_acquire) == slots.size()){
+			backoff(spins);
+		}
+		return &slots[t & mask];
+	}
+
+	void publish(){
+		tail.store(tail.load(memory_order_relaxed) + 1, memory_order_release);
+	}
+
+	// next element, or nullptr if none is ready
+	T* front(){
+		size_t h = head.load(memory_order_relaxed);
+		if (h == tail.load(memory_order_acquire)){
+			return nullptr;
+		}
+		return &slots[h & mask];
+	}
+
+	void pop(){
+		head.store(head.load(memory_order_relaxed) + 1, memory_order_release);
+	}
+
+	// waits for the next element; false once the queue is closed and drained
+	bool pop(T& value){
+		int spins = 0;
+		while (true){
+			if (T* next = front()){
+				value = std::move(*next);
+				pop();
+				return true;
+			}
+			if (finished()){
+				return false;
+			}
+			backoff(spins);
+		}
+	}
+
+	void close(){
+		closed.store(true, memory_order_release);
+	}
+
+	bool finished(){
+		return closed.load(memory_order_acquire) && front() == nullptr;
+	}
+};
+
+// Work for the Gojo or Sukuna lane. Commands that print carry the sequence
+// number their output is merged under; the others have seq -1.
+struct LaneTask {
+	Opcode op;
+	int ID;		// LAPSE: area of the customer
+	int num;	// LAPSE: Result, otherwise the command argument
+	customer* cus;
+	long long seq;
+};
+
+struct LaneOutput {
+	long long seq;
+	string text;
+};
+
+const int LANE_QUEUE_SIZE = 4096;
+
+class ExecutionLane {
+public:
+	SpscQueue<LaneTask> tasks{LANE_QUEUE_SIZE};
+	SpscQueue<LaneOutput> outputs{LANE_QUEUE_SIZE};
+	atomic<long long> completed{0};
+	long long submitted = 0;
+
+	void submit(const LaneTask& task){
+		submitted++;
+		tasks.push(task);
+	}
+
+	void waitIdle(){
+		int spins = 0;
+		while (completed.load(memory_order_acquire) != submitted){
+			backoff(spins);
+		}
+	}
+
+	// worker loop; execute runs one task against the lane's side of r
+	template<class Execute>
+	void run(Execute execute){
+		LaneTask task;
+		ostringstream out;
+		while (tasks.pop(task)){
+			out.str("");
+			execute(task, out);
+			if (task.seq >= 0){
+				outputs.push({task.seq, out.str()});
+			}
+			completed.fetch_add(1, memory_order_release);
+		}
+		outputs.close();
+	}
+};
+
+// Writes the per-lane outputs in script order. Each queue is already
+// ordered by seq, and every seq appears in exactly one of them.
+void mergeOutputs(vector<SpscQueue<LaneOutput>*> queues, ostream& out){
+	long long next = 0;
+	int spins = 0;
+	while (true){
+		bool progressed = false, finished = true;
+		for (auto queue : queues){
+			LaneOutput* head;
+			while ((head = queue->front()) != nullptr && head->seq == next){
+				out << head->text;
+				queue->pop();
+				next++;
+				progressed = true;
+			}
+			finished = finished && queue->finished();
+		}
+		if (progressed){
+			spins = 0;
+		}
+		else if (finished){
+			break;
+		}
+		else {
+			backoff(spins);
+		}
+	}
+	out.flush();
+}
+
+// Runs filename with Gojo and Sukuna on their own threads. After LAPSE works
+// out Result on this thread, odd customers only touch Gojo and even ones only
+// Sukuna; KOKUSEN/LIMITLESS are Gojo-only and KEITEIKEN/CLEAVE Sukuna-only, so
+// each lane owns its side. HAND runs here, since this thread owns
+// lastCustomer. MAXSIZE waits for both lanes to go idle before changing.
+void simulateLanes(string filename)
+{
+	Restaurant* r = new Restaurant();
+	ExecutionLane gojoLane, sukunaLane;
+	SpscQueue<LaneOutput> handOutputs(LANE_QUEUE_SIZE);
+
+	thread gojoWorker([&]{
+		gojoLane.run([r](const LaneTask& task, ostream& out){
+			switch (task.op){
+				case LAPSE_CMD: r->gojo->addCustomer(task.ID, task.num); break;
+				case KOKUSEN_CMD: r->KOKUSEN(); break;
+				case LIMITLESS_CMD: r->LIMITLESS(task.num, out); break;
+				default: break;
+			}
+		});
+	});
+	thread sukunaWorker([&]{
+		sukunaLane.run([r](const LaneTask& task, ostream& out){
+			switch (task.op){
+				case LAPSE_CMD: r->sukuna->addCustomer(task.ID, task.cus, task.num); break;
+				case KEITEIKEN_CMD: r->KEITEIKEN(task.num, out); break;
+				case CLEAVE_CMD: r->CLEAVE(task.num, out); break;
+				default: break;
+			}
+		});
+	});
+	thread writer([&]{
+		mergeOutputs({&handOutputs, &gojoLane.outputs, &sukunaLane.outputs}, cout);
+	});
+
+	ifstream ss(filename);
+	Command cmd;
+	long long seq = 0;
+	ostringstream handOut;
+	while (readCommand(ss, cmd))
+	{
+		switch (cmd.op){
+			case MAXSIZE_CMD:
+				gojoLane.waitIdle();
+				sukunaLane.waitIdle();
+				MAXSIZE = cmd.num;
+				break;
+			case LAPSE_CMD: {
+				string name = cmd.name;
+				int ID, Result;
+				if (!r->admit(name, ID, Result)){
+					break;
+				}
+				if (Result & 1){
+					gojoLane.submit({LAPSE_CMD, ID, Result, nullptr, -1});
+				}
+				else {
+					sukunaLane.submit({LAPSE_CMD, ID, Result, new customer(name, Result), -1});
+				}
+				break;
+			}
+			case HAND_CMD:
+				handOut.str("");
+				r->HAND(handOut);
+				handOutputs.push({seq++, handOut.str()});
+				break;
+			case KOKUSEN_CMD:
+				gojoLane.submit({KOKUSEN_CMD, 0, 0, nullptr, -1});
+				break;
+			case LIMITLESS_CMD:
+				gojoLane.submit({LIMITLESS_CMD, 0, cmd.num, nullptr, seq++});
+				break;
+			case KEITEIKEN_CMD:
+			case CLEAVE_CMD:
+				sukunaLane.submit({cmd.op, 0, cmd.num, nullptr, seq++});
+				break;
+		}
+	}
+	gojoLane.tasks.close();
+	sukunaLane.tasks.close();
+	handOutputs.close();
+	gojoWorker.join();
+	sukunaWorker.join();
+	writer.join();
+	if (memoryReport){
+		memoryStats.print(cerr);
+	}
+	delete r;
+}
+
+const int PARSE_RING_SIZE = 1024;
+
+// Reads and decodes filename on a parser thread while this thread executes,
+// so file reads and tokenizing overlap with execution. Decoded commands pass
+// through a bounded SPSC ring; the parser waits when it is full.
+void simulatePipelined(string filename)
+{
+	Restaurant* r = new Restaurant();
+	SpscQueue<Command> ring(PARSE_RING_SIZE);
+
+	thread parser([&]{
+		ifstream ss(filename);
+		Command cmd;
+		while (readCommand(ss, cmd)){
+			Command* slot = ring.claim();
+			slot->op = cmd.op;
+			slot->num = cmd.num;
+			slot->name.assign(cmd.name);
+			ring.publish();
+		}
+		ring.close();
+	});
+
+	int spins = 0;
+	while (true){
+		if (Command* next = ring.front()){
+			runCommand(r, *next);
+			ring.pop();
+			spins = 0;
+		}
+		else if (ring.finished()){
+			break;
+		}
+		else {
+			backoff(spins);
+		}
+	}
+	parser.join();
+	if (memoryReport){
+		memoryStats.print(cerr);
+	}
+	delete r;
+}
+
+enum FlushPolicy { FLUSH_LATENCY, FLUSH_THROUGHPUT };
+
+// Response latency per command type, bucketed by powers of two nanoseconds so
+// a long-running stream keeps constant memory.
+struct LatencyStats {
+	static const int BUCKETS = 48;
+	long long count[7] = {};
+	double total[7] = {};
+	double worst[7] = {};
+	long long buckets[7][BUCKETS] = {};
+
+	void record(Opcode op, double seconds){
+		count[op]++;
+		total[op] += seconds;
+		worst[op] = max(worst[op], seconds);
+		long long ns = (long long)(seconds * 1e9);
+		int bucket = 0;
+		while (bucket < BUCKETS - 1 && (1LL << bucket) < ns){
+			bucket++;
+		}
+		buckets[op][bucket]++;
+	}
+
+	// upper bound of the bucket holding the given quantile, in seconds, but
+	// never above the slowest recorded command
+	double quantile(int op, double q){
+		long long rank = (long long)ceil(q * count[op]), seen = 0;
+		for (int bucket = 0; bucket < BUCKETS; bucket++){
+			seen += buckets[op][bucket];
+			if (seen >= rank){
+				return min((1LL << bucket) / 1e9, worst[op]);
+			}
+		}
+		return worst[op];
+	}
+
+	void print(ostream& out){
+		out << fixed << setprecision(1);
+		out << "command     count   mean(us)    p50(us)    p99(us)    max(us)\n";
+		for (int op = 0; op < 7; op++){
+			if (count[op] == 0){
+				continue;
+			}
+			out << left << setw(10) << opcodeNames[op] << right << setw(7) << count[op]
+				<< setw(11) << total[op] / count[op] * 1e6 << setw(11) << quantile(op, 0.5) * 1e6
+				<< setw(11) << quantile(op, 0.99) * 1e6 << setw(11) << worst[op] * 1e6 << "\n";
+		}
+	}
+};
+
+// Strict counterpart of readCommand for live input: one command per line,
+// the opcode must be known and its argument present and numeric where one is
+// expected. Returns why the line was rejected, or an empty string.
+string parseStreamCommand(const string& line, Command& cmd){
+	istringstream in(line);
+	string str, arg, extra;
+	in >> str;
+	int op = 0;
+	while (op < 7 && str != opcodeNames[op]){
+		op++;
+	}
+	if (op == 7){
+		return "unknown command";
+	}
+	cmd.op = (Opcode)op;
+	bool takesArg = cmd.op != KOKUSEN_CMD && cmd.op != HAND_CMD;
+	if (takesArg && !(in >> arg)){
+		return "missing argument";
+	}
+	if (in >> extra){
+		return "unexpected argument";
+	}
+	if (cmd.op == LAPSE_CMD){
+		if (MAXSIZE <= 0){
+			return "LAPSE before a positive MAXSIZE";
+		}
+		cmd.name = arg;
+	}
+	else if (takesArg){
+		size_t used = 0;
+		try {
+			cmd.num = stoi(arg, &used);
+		}
+		catch (const invalid_argument&){
+			return "argument is not a number";
+		}
+		catch (const out_of_range&){
+			return "argument out of range";
+		}
+		if (used != arg.size()){
+			return "argument is not a number";
+		}
+		if (cmd.op == MAXSIZE_CMD && cmd.num <= 0){
+			return "MAXSIZE must be positive";
+		}
+	}
+	return "";
+}
+
+// Runs commands from in against a resident Restaurant until in ends, writing
+// their output to out. A malformed line is reported on cerr and skipped so
+// the resident state survives it. FLUSH_LATENCY flushes after every command;
+// FLUSH_THROUGHPUT only once no further input is buffered.
+void serveStream(Restaurant* r, istream& in, ostream& out, FlushPolicy policy, LatencyStats& stats){
+	streambuf* console = cout.rdbuf(out.rdbuf());
+	Command cmd;
+	string line;
+	while (getline(in, line)){
+		if (line.find_first_not_of(" \t\r") == string::npos){
+			continue;
+		}
+		string error = parseStreamCommand(line, cmd);
+		if (!error.empty()){
+			cerr << "rejected \"" << line << "\": " << error << "\n";
+			continue;
+		}
+		auto start = chrono::steady_clock::now();
+		runCommand(r, cmd);
+		if (policy == FLUSH_LATENCY || in.rdbuf()->in_avail() <= 0){
+			cout.flush();
+		}
+		stats.record(cmd.op, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+	}
+	cout.flush();
+	cout.rdbuf(console);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STREAM_POSIX 1
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+volatile sig_atomic_t stopStreaming = 0;
+
+void requestStop(int){
+	stopStreaming = 1;
+}
+
+// Buffered stream over a file descriptor. A read interrupted by SIGINT or
+// SIGTERM reads as end of input.
+class FdBuffer : public streambuf {
+private:
+	int fd;
+	char input[1 << 16];
+	char output[1 << 16];
+public:
+	FdBuffer(int fd) : fd(fd) {
+		setg(input, input, input);
+		setp(output, output + sizeof(output));
+	}
+	~FdBuffer(){
+		sync();
+	}
+protected:
+	int underflow() override {
+		ssize_t n;
+		do {
+			n = read(fd, input, sizeof(input));
+		} while (n < 0 && errno == EINTR && !stopStreaming);
+		if (n <= 0){
+			return traits_type::eof();
+		}
+		setg(input, input, input + n);
+		return traits_type::to_int_type(input[0]);
+	}
+	int overflow(int c) override {
+		if (sync() == -1){
+			return traits_type::eof();
+		}
+		if (c != traits_type::eof()){
+			*pptr() = c;
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+	int sync() override {
+		char* p = pbase();
+		while (p < pptr()){
+			ssize_t n = write(fd, p, pptr() - p);
+			if (n < 0 && errno == EINTR){
+				continue;
+			}
+			if (n <= 0){
+				setp(output, output + sizeof(output));
+				return -1;
+			}
+			p += n;
+		}
+		setp(output, output + sizeof(output));
+		return 0;
+	}
+};
+#endif
+
+// Long-running front end. source is "-" for stdin, "unix:PATH" for a local
+// socket served one client at a time (output goes back to the client), or
+// the path of a FIFO, which is reopened whenever its writers close it; any
+// other path is read once. One Restaurant stays resident for the whole run;
+// latencies go to cerr when the input ends or on SIGINT/SIGTERM. Returns
+// false when the source could not be opened.
+bool simulateStream(string source, FlushPolicy policy){
+	Restaurant* r = new Restaurant();
+	LatencyStats stats;
+	bool served = true;
+#ifdef STREAM_POSIX
+	struct sigaction action = {};
+	action.sa_handler = requestStop;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+	signal(SIGPIPE, SIG_IGN);
+
+	if (source == "-"){
+		FdBuffer inBuf(0), outBuf(1);
+		istream in(&inBuf);
+		ostream out(&outBuf);
+		serveStream(r, in, out, policy, stats);
+	}
+	else if (source.compare(0, 5, "unix:") == 0){
+		string path = source.substr(5);
+		int server = socket(AF_UNIX, SOCK_STREAM, 0);
+		sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		if (server < 0 || path.size() >= sizeof(address.sun_path)){
+			cerr << "cannot create socket " << path << "\n";
+			delete r;
+			return false;
+		}
+		strcpy(address.sun_path, path.c_str());
+		unlink(path.c_str());
+		if (bind(server, (sockaddr*)&address, sizeof(address)) < 0 || listen(server, 16) < 0){
+			cerr << "cannot listen on " << path << ": " << strerror(errno) << "\n";
+			close(server);
+			delete r;
+			return false;
+		}
+		while (!stopStreaming){
+			int client = accept(server, nullptr, nullptr);
+			if (client < 0){
+				continue;
+			}
+			{
+				FdBuffer buffer(client);
+				istream in(&buffer);
+				ostream out(&buffer);
+				serveStream(r, in, out, policy, stats);
+			}
+			close(client);
+		}
+		close(server);
+		unlink(path.c_str());
+	}
+	else {
+		FdBuffer outBuf(1);
+		ostream out(&outBuf);
+		while (!stopStreaming){
+			int fifo = open(source.c_str(), O_RDONLY);
+			if (fifo < 0){
+				if (errno != EINTR){
+					cerr << "cannot open " << source << ": " << strerror(errno) << "\n";
+					served = false;
+					break;
+				}
+				continue;
+			}
+			// only a FIFO gets new writers; anything else is read once
+			struct stat info;
+			bool reopen = fstat(fifo, &info) == 0 && S_ISFIFO(info.st_mode);
+			{
+				FdBuffer inBuf(fifo);
+				istream in(&inBuf);
+				serveStream(r, in, out, policy, stats);
+			}
+			close(fifo);
+			if (!reopen){
+				break;
+			}
+		}
+	}
+#else
+	if (source != "-"){
+		cerr << "only stdin streaming is supported on this platform\n";
+		delete r;
+		return false;
+	}
+	serveStream(r, cin, cout, policy, stats);
+#endif
+	stats.print(cerr);
+	if (memoryReport){
+		memoryStats.print(cerr);
+	}
+	delete r;
+	return served;
+}